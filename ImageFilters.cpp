@@ -2,32 +2,26 @@
 
 
 std::vector<std::vector<double>> GaussianKernel(double sigma, int KernelDimension){
-    std::vector<std::vector<double>> GKernel;
-    std::vector<double> vec;
-    
-    for(int j = 0; j < KernelDimension; ++j){
-        for(int i = 0; i < KernelDimension; ++i){
-            vec.push_back(0); 
-        }
-        GKernel.push_back(vec);
-    }
+    const int radius = KernelDimension / 2;
+    std::vector<std::vector<double>> GKernel(KernelDimension, std::vector<double>(KernelDimension, 0));
+
     //iniatializing standard deviation
     double r, s = 2.0 * sigma * sigma;
 
     //sum is used for normalization
     double sum = 0.0;
 
-    //generating 5x5 kernel
-    for(int x = -2; x <= 2; ++x){
-        for(int y = -2; y <= 2; ++y){
+    //generating KernelDimension x KernelDimension kernel
+    for(int x = -radius; x <= radius; ++x){
+        for(int y = -radius; y <= radius; ++y){
             r = sqrt(x * x + y * y);
-            GKernel[x + 2][y + 2] = (exp(-(r * r) / s)) / (M_PI * s);
-            sum += GKernel[x + 2][y + 2];
+            GKernel[x + radius][y + radius] = (exp(-(r * r) / s)) / (M_PI * s);
+            sum += GKernel[x + radius][y + radius];
         }
     }
 
-    for (int i = 0; i < 5; ++i){
-        for (int j = 0; j < 5; ++j){
+    for (int i = 0; i < KernelDimension; ++i){
+        for (int j = 0; j < KernelDimension; ++j){
             GKernel[i][j] /= sum;
         }
     }
@@ -36,67 +30,115 @@ std::vector<std::vector<double>> GaussianKernel(double sigma, int KernelDimensio
 }
 
 
-std::vector<SDL_Color> GaussianBlur(const std::vector<SDL_Color>& colorVec, const size_t x_axis, double sigma, int KernelDimension){
-    const uint16_t BORDER_DISTANCE = 5;
-    size_t valueSum;//sum of all surrounding pixel values
-    uint8_t avgValue;//the average value of surrounding pixels using kernel
-    double kernelSum;//the sum of all the kernel values
-    std::vector<std::vector<double>> GKernel = GaussianKernel(sigma, KernelDimension);
-    std::vector<SDL_Color> imageBlurred;
-    SDL_Color color;
-    uint16_t h, w;//indexes to keep track of kernel iterations
-
+/// @brief Copies the blue channel (all channels are equal) into a contiguous 8 bit plane.
+static std::vector<uint8_t> intensityPlane(const std::vector<SDL_Color>& colorVec){
+    std::vector<uint8_t> plane(colorVec.size());
     for(size_t i = 0; i < colorVec.size(); ++i){
-        valueSum = kernelSum = h = w = 0;
-
-        //checks if i is not within 5 pixels of the edges
-        if(i > (x_axis * BORDER_DISTANCE) && (i % x_axis) > BORDER_DISTANCE && i < ((i / x_axis - BORDER_DISTANCE) * x_axis) && (i % x_axis) < (x_axis - BORDER_DISTANCE)){
-            
-            for (uint16_t y = (i / x_axis) - 2; y < (i / x_axis) + 3; ++y){
-                for (uint16_t x = (i % x_axis) - 2; x < (i % x_axis) + 3; ++x){
-                    valueSum += colorVec[y * x_axis + x].b * GKernel[h][w];
-                    kernelSum += GKernel[h][w];
-                    ++w;
-                }
-                w = 0;
-                ++h;
-            }
-            avgValue = valueSum / kernelSum;
-            color.b = color.g = color.r = avgValue;
-            color.a = 255;
-            imageBlurred.push_back(color);
-        }else{
-            imageBlurred.push_back(colorVec[i]);
+        plane[i] = colorVec[i].b;
+    }
+    return plane;
+}
+
+
+/// @brief Writes the filtered plane back to the image, pixels within border of the edges keep their original value.
+static std::vector<SDL_Color> applyInterior(const std::vector<SDL_Color>& colorVec, const std::vector<float>& filtered, size_t x_axis, size_t border){
+    const size_t y_axis = colorVec.size() / x_axis;
+    std::vector<SDL_Color> imageBlurred(colorVec);
+    if(x_axis <= 2 * border || y_axis <= 2 * border){
+        return imageBlurred;
+    }
+
+    for(size_t y = border; y < y_axis - border; ++y){
+        for(size_t x = border; x < x_axis - border; ++x){
+            SDL_Color& pixel = imageBlurred[y * x_axis + x];
+            pixel.b = pixel.g = pixel.r = (uint8_t) filtered[y * x_axis + x];
+            pixel.a = 255;
         }
     }
     return imageBlurred;
+}
+
+
+std::vector<SDL_Color> GaussianBlur(const std::vector<SDL_Color>& colorVec, const size_t x_axis, double sigma, int KernelDimension){
+    const size_t radius = KernelDimension / 2;
+    const size_t border = radius > BORDER_DISTANCE ? radius : BORDER_DISTANCE;
+    std::vector<uint8_t> plane = intensityPlane(colorVec);
 
+    //the standard detection kernels use weights generated at compile time
+    if(KernelDimension == 5 && sigma == 1.0){
+        return applyInterior(colorVec, convolve<GaussianKernelTable<2, 10>>(plane, x_axis), x_axis, border);
+    }
+    if(KernelDimension == 3 && sigma == 1.0){
+        return applyInterior(colorVec, convolve<GaussianKernelTable<1, 10>>(plane, x_axis), x_axis, border);
+    }
+
+    //the 2D Gaussian is the outer product of the 1D one, so the middle row of the normalized kernel is separable too
+    std::vector<std::vector<double>> kernel = GaussianKernel(sigma, KernelDimension);
+    std::vector<float> weights(KernelDimension);
+    double sum = 0.0;
+    for(int i = 0; i < KernelDimension; ++i){
+        sum += kernel[radius][i];
+    }
+    for(int i = 0; i < KernelDimension; ++i){
+        weights[i] = kernel[radius][i] / sum;
+    }
+    return applyInterior(colorVec, convolveGeneric(std::vector<float>(plane.begin(), plane.end()), x_axis, weights), x_axis, border);
 }
 
 
 std::vector<SDL_Color> boxBlur(const std::vector<SDL_Color>& colorVec, size_t x_axis){
-    size_t valueSum;//sum of all surrounding pixel values
-    SDL_Color avgValue;//the average value of surrounding pixels
-    uint16_t index;
-    std::vector<SDL_Color> imageBlurred;
-    avgValue.a = 0xFF;
-    for(size_t i = 0; i < colorVec.size(); ++i){
-        //checks if i is not within 5 pixels of the edges
-        valueSum = 0;
-        index = 0;
- 
-        if(i > (size_t) (x_axis * 5) && (i % x_axis) > 5 && i < ((i / x_axis - 5) * x_axis) && (int) (i % x_axis) < (int) (x_axis - 5)){
-            for (uint16_t y = (i / x_axis) - 2; y < (i / x_axis) + 3; ++y){
-                for (uint16_t x = (i % x_axis) - 2; x < (i % x_axis) + 3; ++x){
-                    valueSum += colorVec[y * x_axis + x].b;
-                    index+=1;
-                }
+    return applyInterior(colorVec, convolve<BoxKernelTable<2>>(intensityPlane(colorVec), x_axis), x_axis, BORDER_DISTANCE);
+}
+
+
+std::vector<float> convolveGeneric(const std::vector<float>& plane, size_t x_axis, const std::vector<float>& weights){
+    const long radius = weights.size() / 2;
+    const long width = x_axis;
+    const long height = plane.size() / x_axis;
+    std::vector<float> rows(plane.size());
+    std::vector<float> filtered(plane.size());
+
+    for(long y = 0; y < height; ++y){
+        for(long x = 0; x < width; ++x){
+            float valueSum = 0.0f;
+            for(long k = -radius; k <= radius; ++k){
+                valueSum += weights[k + radius] * plane[y * width + mirrorIndex(x + k, width)];
             }
-            avgValue.b = avgValue.r = avgValue.g = valueSum / index;
-            imageBlurred.push_back(avgValue);
-        }else{
-            imageBlurred.push_back(colorVec[i]);
+            rows[y * width + x] = valueSum;
         }
     }
-    return imageBlurred;
-}
\ No newline at end of file
+    for(long y = 0; y < height; ++y){
+        for(long x = 0; x < width; ++x){
+            float valueSum = 0.0f;
+            for(long k = -radius; k <= radius; ++k){
+                valueSum += weights[k + radius] * rows[mirrorIndex(y + k, height) * width + x];
+            }
+            filtered[y * width + x] = valueSum;
+        }
+    }
+    return filtered;
+}
+
+
+std::vector<float> atrousSmooth(const std::vector<float>& plane, size_t x_axis, size_t step){
+    return convolve<B3SplineKernel>(plane, x_axis, step);
+}
+
+
+WaveletPlanes atrousTransform(const std::vector<SDL_Color>& colorVec, size_t x_axis, int scales){
+    WaveletPlanes planes;
+    std::vector<uint8_t> intensity = intensityPlane(colorVec);
+    std::vector<float> previous(intensity.begin(), intensity.end());
+
+    //c(j+1) = h(j) * c(j) and w(j+1) = c(j) - c(j+1), so each scale costs one small dilated blur
+    for(int j = 0; j < scales; ++j){
+        std::vector<float> smoothed = atrousSmooth(previous, x_axis, (size_t) 1 << j);
+        for(size_t i = 0; i < previous.size(); ++i){
+            previous[i] -= smoothed[i];
+        }
+        planes.coefficients.push_back(std::move(previous));
+        previous = std::move(smoothed);
+    }
+    planes.residual = std::move(previous);
+    return planes;
+}
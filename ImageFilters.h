@@ -3,9 +3,14 @@
 
 #include <iostream>
 #include <vector>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <SDL2/SDL.h>
 
+//pixels closer than this to the edges are copied without filtering
+#define BORDER_DISTANCE 5
+
 
 /// @brief Generates Gaussian Kernel
 /// @param sigma Standard deviation
@@ -14,11 +19,12 @@
 std::vector<std::vector<double>> GaussianKernel(double sigma, int KernelDimension);
 
 
-/// @brief Applies Gaussian filter. 
-/// @param colorVec Vector of SDL_Color, containing the image to be blurred. 
-/// @param sigma Standard deviation in the creation of the Kernel 
+/// @brief Applies Gaussian filter.
+/// @param colorVec Vector of SDL_Color, containing the image to be blurred.
+/// @param sigma Standard deviation in the creation of the Kernel
 /// @param KernelDimension The size of the kernel used
 /// @return SDL_Color vector with Gaussian filter applied
+/// @note Dispatches to a kernel specialized at compile time for the common sizes, other sizes use the generic path.
 std::vector<SDL_Color> GaussianBlur(const std::vector<SDL_Color>& colorVec,const size_t x_axis, double sigma, int KernelDimension);
 
 
@@ -27,4 +33,200 @@ std::vector<SDL_Color> GaussianBlur(const std::vector<SDL_Color>& colorVec,const
 /// @return image with box blur applied. Image is stored in SDL_Color vector
 std::vector<SDL_Color> boxBlur(const std::vector<SDL_Color>& colorVec, size_t x_axis);
 
-#endif
\ No newline at end of file
+
+/// @brief Generic separable convolution used when no specialized kernel exists for the requested size.
+/// @param plane Intensity plane to be filtered.
+/// @param x_axis Width of the plane.
+/// @param weights 1D kernel of 2 * radius + 1 normalized weights, applied along rows then columns.
+/// @return Filtered plane, borders are mirrored.
+std::vector<float> convolveGeneric(const std::vector<float>& plane, size_t x_axis, const std::vector<float>& weights);
+
+
+/// @brief Planes of the a trous (starlet) wavelet transform.
+struct WaveletPlanes{
+    std::vector<std::vector<float>> coefficients;//wavelet coefficients, finest scale first
+    std::vector<float> residual;//smoothed plane of the coarsest scale (background)
+};
+
+
+/// @brief Smooths a plane with the B3-spline kernel dilated by step (holes between the taps).
+/// @param plane Plane to be smoothed.
+/// @param x_axis Width of the plane.
+/// @param step Distance between kernel taps, 2^scale.
+/// @return Smoothed plane, borders are mirrored.
+std::vector<float> atrousSmooth(const std::vector<float>& plane, size_t x_axis, size_t step);
+
+
+/// @brief Computes the a trous wavelet transform, every scale is smoothed from the previous one.
+/// @param colorVec Image stored in vector of SDL_Color objects.
+/// @param x_axis Width of the image.
+/// @param scales Number of wavelet scales.
+/// @return Wavelet coefficients of every scale and the residual plane.
+WaveletPlanes atrousTransform(const std::vector<SDL_Color>& colorVec, size_t x_axis, int scales);
+
+
+/// @brief Compile time exponential (Taylor series), std::exp is not constexpr.
+/// @param x Exponent, expected to be small and non positive as in a Gaussian.
+/// @return e^x
+constexpr double constexprExp(double x){
+    double term = 1.0, sum = 1.0;
+    for(int n = 1; n < 40; ++n){
+        term *= x / n;
+        sum += term;
+    }
+    return sum;
+}
+
+
+/// @brief Normalized 1D Gaussian kernel generated at compile time, the 2D kernel is its outer product.
+/// @tparam Radius Radius of the kernel, dimension is 2 * Radius + 1.
+/// @tparam SigmaTenths Standard deviation in tenths of a pixel (template parameters can't be double).
+template <int Radius, int SigmaTenths>
+struct GaussianKernelTable{
+    static constexpr int RADIUS = Radius;
+    static constexpr int DIMENSION = 2 * Radius + 1;
+
+    static constexpr std::array<float, DIMENSION> generate(){
+        std::array<double, DIMENSION> exact{};
+        std::array<float, DIMENSION> weights{};
+        const double sigma = SigmaTenths / 10.0;
+        double sum = 0.0;
+        for(int x = -Radius; x <= Radius; ++x){
+            exact[x + Radius] = constexprExp(-(x * x) / (2.0 * sigma * sigma));
+            sum += exact[x + Radius];
+        }
+        for(int i = 0; i < DIMENSION; ++i){
+            weights[i] = exact[i] / sum;
+        }
+        return weights;
+    }
+
+    static constexpr std::array<float, DIMENSION> weights = generate();
+};
+
+
+/// @brief Normalized 1D box kernel generated at compile time.
+/// @tparam Radius Radius of the kernel, dimension is 2 * Radius + 1.
+template <int Radius>
+struct BoxKernelTable{
+    static constexpr int RADIUS = Radius;
+    static constexpr int DIMENSION = 2 * Radius + 1;
+
+    static constexpr std::array<float, DIMENSION> generate(){
+        std::array<float, DIMENSION> weights{};
+        for(int i = 0; i < DIMENSION; ++i){
+            weights[i] = 1.0 / DIMENSION;
+        }
+        return weights;
+    }
+
+    static constexpr std::array<float, DIMENSION> weights = generate();
+};
+
+
+/// @brief 1D B3-spline kernel of the a trous transform.
+struct B3SplineKernel{
+    static constexpr int RADIUS = 2;
+    static constexpr int DIMENSION = 5;
+    static constexpr std::array<float, DIMENSION> weights = {1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16};
+
+    //standard deviation of each scale for unit Gaussian noise, coarser scales roughly halve
+    static constexpr std::array<float, 7> noiseFactors = {0.890f, 0.201f, 0.086f, 0.041f, 0.020f, 0.010f, 0.006f};
+
+    static constexpr float noiseFactor(size_t scale){
+        if(scale < noiseFactors.size()){return noiseFactors[scale];}
+        return noiseFactors.back() / (1 << (scale - noiseFactors.size() + 1));
+    }
+};
+
+
+/// @brief Mirrors an index that falls outside [0, size).
+inline long mirrorIndex(long index, long size){
+    if(index < 0){index = -index;}
+    if(index >= size){index = 2 * (size - 1) - index;}
+    if(index < 0){index = 0;}//dilated taps can overshoot small planes twice
+    return index;
+}
+
+
+/// @brief Filters every row with a compile time kernel, only the taps near the ends are mirrored.
+/// @tparam Kernel Kernel table with static constexpr RADIUS and weights.
+/// @tparam Pixel Pixel type of the input plane (uint8_t for the 8 bit image, float for wavelet planes), the output is float.
+/// @param step Distance between kernel taps (1, or 2^scale for the a trous transform).
+template <typename Kernel, typename Pixel>
+void convolveRows(const Pixel* __restrict in, float* __restrict out, long width, long height, long step){
+    constexpr int R = Kernel::RADIUS;
+    const long reach = R * step;
+    const long interiorEnd = width - reach;
+
+    for(long y = 0; y < height; ++y){
+        const Pixel* __restrict row = in + y * width;
+        float* __restrict outRow = out + y * width;
+
+        for(long x = 0; x < width; ++x){
+            if(x == reach && reach < interiorEnd){
+                //interior, no index checks so the compiler can vectorize along x
+                for(; x < interiorEnd; ++x){
+                    float valueSum = 0.0f;
+                    #pragma GCC unroll 16
+                    for(int k = 0; k < Kernel::DIMENSION; ++k){
+                        valueSum += Kernel::weights[k] * row[x + (k - R) * step];
+                    }
+                    outRow[x] = valueSum;
+                }
+                if(x >= width){break;}
+            }
+            float valueSum = 0.0f;
+            for(int k = 0; k < Kernel::DIMENSION; ++k){
+                valueSum += Kernel::weights[k] * row[mirrorIndex(x + (k - R) * step, width)];
+            }
+            outRow[x] = valueSum;
+        }
+    }
+}
+
+
+/// @brief Filters every column with a compile time kernel, rows are combined whole so the loop runs contiguously along x.
+/// @tparam Kernel Kernel table with static constexpr RADIUS and weights.
+/// @param step Distance between kernel taps (1, or 2^scale for the a trous transform).
+template <typename Kernel>
+void convolveColumns(const float* __restrict in, float* __restrict out, long width, long height, long step){
+    constexpr int R = Kernel::RADIUS;
+    const float* taps[Kernel::DIMENSION];
+
+    for(long y = 0; y < height; ++y){
+        for(int k = 0; k < Kernel::DIMENSION; ++k){
+            taps[k] = in + mirrorIndex(y + (k - R) * step, height) * width;
+        }
+        float* __restrict outRow = out + y * width;
+        for(long x = 0; x < width; ++x){
+            float valueSum = 0.0f;
+            #pragma GCC unroll 16
+            for(int k = 0; k < Kernel::DIMENSION; ++k){
+                valueSum += Kernel::weights[k] * taps[k][x];
+            }
+            outRow[x] = valueSum;
+        }
+    }
+}
+
+
+/// @brief Separable convolution with the kernel weights fixed at compile time.
+/// @tparam Kernel Kernel table with static constexpr RADIUS and weights.
+/// @tparam Pixel Pixel type of the input plane, converted to float by the row pass.
+/// @param plane Intensity plane to be filtered.
+/// @param x_axis Width of the plane.
+/// @param step Distance between kernel taps (1, or 2^scale for the a trous transform).
+/// @return Filtered plane, borders are mirrored.
+template <typename Kernel, typename Pixel>
+std::vector<float> convolve(const std::vector<Pixel>& plane, size_t x_axis, size_t step = 1){
+    const long width = x_axis;
+    const long height = plane.size() / x_axis;
+    std::vector<float> rows(plane.size());
+    std::vector<float> filtered(plane.size());
+    convolveRows<Kernel, Pixel>(plane.data(), rows.data(), width, height, step);
+    convolveColumns<Kernel>(rows.data(), filtered.data(), width, height, step);
+    return filtered;
+}
+
+#endif
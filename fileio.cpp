@@ -1,15 +1,23 @@
 #include "fileio.h"
+#include <algorithm>
+#include <zlib.h>
 
 std::ifstream* createFileStream(){
+    return createFileStream(FILENAME);
+}
+
+
+std::ifstream* createFileStream(const std::string& filename){
 
     //using pointers to be able to return the loaded file
-    std::ifstream* file = new std::ifstream(FILENAME, std::ios::binary);
+    std::ifstream* file = new std::ifstream(filename, std::ios::binary);
 
     if (file->is_open()){
         std::cout << "File loaded." << std::endl;
         return file;
     }else{
         std::cerr << "File not found." << std::endl;
+        delete file;
         return nullptr;
     }
 }
@@ -25,18 +33,147 @@ char* getHeader(std::ifstream* file){
 
 
 std::vector<uint16_t> getImage(std::ifstream* file){
+    std::vector<uint16_t> imageVec;
+    getImage(file, imageVec);
+    return imageVec;
+}
+
+
+void getImage(std::ifstream* file, std::vector<uint16_t>& imageVec){
     //this is a very janky way of seeking to some point
     //to remove artifacts on top of the image and to
     //also center it
     //NEED PERMANENT SOLUTION AT END OF PROJECT
+    file->seekg(0, std::ios::end);
+    std::streamoff fileSize = file->tellg();
+    std::streamoff imageBytes = fileSize > HEADER_SIZE * 5 ? fileSize - HEADER_SIZE * 5 : 0;
     file->seekg(HEADER_SIZE * 5, std::ios::beg);
 
-    
-    std::vector<uint16_t> imageVec;
-    uint16_t pixel;
-    while(file->read(reinterpret_cast<char*>(&pixel), sizeof(uint16_t))){
-        imageVec.push_back(pixel);
+    //reads every whole pixel in one go instead of one pixel at a time
+    imageVec.resize(imageBytes / sizeof(uint16_t));
+    file->read(reinterpret_cast<char*>(imageVec.data()), imageVec.size() * sizeof(uint16_t));
+}
+
+
+void writeCatalogue(std::ostream& out, std::vector<Star>& stars, int binning){
+    //binned pixels are converted back to the center of their block in the full resolution image
+    const int offset = binning / 2;
+    out << "# index x y pixels closest distance" << std::endl;
+    for(size_t i = 0; i < stars.size(); ++i){
+        Star* closest = stars[i].getClosestStar();
+        out << i << " " << stars[i].avgX * binning + offset << " " << stars[i].avgY * binning + offset << " " << stars[i].getSize() * binning * binning << " ";
+        if(closest != nullptr){
+            out << (closest - &stars[0]) << " " << stars[i].getDistanceFromClosestStar() * binning << std::endl;
+        }else{
+            out << "-1 -1" << std::endl;
+        }
     }
+}
 
-    return imageVec;
-}
\ No newline at end of file
+
+std::vector<SDL_Color> getBinnedImage(std::ifstream* file, int binning){
+    const size_t binnedX = X_AXIS / binning;
+    const size_t binnedY = Y_AXIS / binning;
+    std::vector<uint16_t> rows((size_t) X_AXIS * binning);//the rows of one block
+    std::vector<uint32_t> blockSums(binnedX);
+    std::vector<SDL_Color> colorVec;
+    SDL_Color color;
+    color.a = 255;
+    colorVec.reserve(binnedX * binnedY);
+
+    file->clear();
+    file->seekg(HEADER_SIZE * 5, std::ios::beg);
+    for(size_t by = 0; by < binnedY; ++by){
+        if(!file->read(reinterpret_cast<char*>(rows.data()), rows.size() * sizeof(uint16_t))){
+            return std::vector<SDL_Color>();
+        }
+
+        std::fill(blockSums.begin(), blockSums.end(), 0);
+        for(int r = 0; r < binning; ++r){
+            const uint16_t* row = &rows[r * X_AXIS];
+            for(size_t bx = 0; bx < binnedX; ++bx){
+                for(int k = 0; k < binning; ++k){
+                    //same 8 bit value convertToColor() uses, so the detection threshold still applies
+                    blockSums[bx] += (uint8_t) row[bx * binning + k];
+                }
+            }
+        }
+
+        for(size_t bx = 0; bx < binnedX; ++bx){
+            color.b = color.g = color.r = blockSums[bx] / (binning * binning);
+            colorVec.push_back(color);
+        }
+    }
+    return colorVec;
+}
+
+
+bool writePGM(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis){
+    std::ofstream image(filename, std::ios::binary);
+    if(!image.is_open()){return false;}
+
+    image << "P5\n" << x_axis << " " << colorVec.size() / x_axis << "\n255\n";
+    for(const SDL_Color& pixel : colorVec){
+        image.put(pixel.b);
+    }
+    return image.good();
+}
+
+
+/// @brief Appends a 32 bit big endian integer, the byte order PNG uses.
+static void appendBigEndian(std::string& data, uint32_t value){
+    data.push_back(value >> 24);
+    data.push_back(value >> 16);
+    data.push_back(value >> 8);
+    data.push_back(value);
+}
+
+/// @brief Writes one PNG chunk: length, type, data and the CRC of type and data.
+static void writeChunk(std::ofstream& image, const char* type, const std::string& data){
+    std::string chunk;
+    appendBigEndian(chunk, data.size());
+    chunk.append(type, 4);
+    chunk += data;
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(chunk.data() + 4), chunk.size() - 4);
+    appendBigEndian(chunk, crc);
+    image.write(chunk.data(), chunk.size());
+}
+
+
+bool writePNG(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis){
+    const size_t y_axis = colorVec.size() / x_axis;
+
+    //every row starts with filter type 0 (none)
+    std::vector<Bytef> raw;
+    raw.reserve(y_axis * (x_axis * 3 + 1));
+    for(size_t y = 0; y < y_axis; ++y){
+        raw.push_back(0);
+        for(size_t x = 0; x < x_axis; ++x){
+            const SDL_Color& pixel = colorVec[y * x_axis + x];
+            raw.push_back(pixel.r);
+            raw.push_back(pixel.g);
+            raw.push_back(pixel.b);
+        }
+    }
+
+    uLongf compressedSize = compressBound(raw.size());
+    std::string compressed(compressedSize, '\0');
+    if(compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize, raw.data(), raw.size(), Z_DEFAULT_COMPRESSION) != Z_OK){
+        return false;
+    }
+    compressed.resize(compressedSize);
+
+    std::ofstream image(filename, std::ios::binary);
+    if(!image.is_open()){return false;}
+
+    std::string header;
+    appendBigEndian(header, x_axis);
+    appendBigEndian(header, y_axis);
+    header += std::string("\x08\x02\x00\x00\x00", 5);//8 bit depth, RGB, deflate, no filter, no interlace
+
+    image.write("\x89PNG\r\n\x1a\n", 8);
+    writeChunk(image, "IHDR", header);
+    writeChunk(image, "IDAT", compressed);
+    writeChunk(image, "IEND", "");
+    return image.good();
+}
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <string>
+#include "Stars.h"
 
 #define HEADER_SIZE 2880
 #define FILENAME "dss_search"
@@ -14,6 +16,11 @@
 /// @return Pointer to file object with binary format.
 std::ifstream* createFileStream();
 
+/// @brief Loads image data stream into file.
+/// @param filename Path of the FITS file.
+/// @return Pointer to file object with binary format, nullptr if the file can't be opened.
+std::ifstream* createFileStream(const std::string& filename);
+
 /// @brief Gathers the header data.
 /// @param file File stream
 /// @return Header char
@@ -24,4 +31,35 @@ char* getHeader(std::ifstream* file);
 /// @return Unsigned 16bit integer vector containing image data.
 std::vector<uint16_t> getImage(std::ifstream* file);
 
+/// @brief Reads binary data from file stream into an existing vector, so its memory can be reused.
+/// @param file File stream
+/// @param imageVec Vector the image data is stored in, previous contents are discarded.
+void getImage(std::ifstream* file, std::vector<uint16_t>& imageVec);
+
+/// @brief Writes the catalogue of detected stars, one star per line.
+/// @param out Stream to write to.
+/// @param stars Vector containing detected stars.
+/// @param binning Binning factor of the image the stars were detected on, positions are written in full resolution pixels.
+void writeCatalogue(std::ostream& out, std::vector<Star>& stars, int binning = 1);
+
+/// @brief Reads the image and bins it in the same pass, only the rows that are needed are read.
+/// @param file File stream
+/// @param binning Binning factor, every binning x binning block becomes one pixel with the average value.
+/// @return Binned image of (X_AXIS / binning) x (Y_AXIS / binning) pixels, empty if the file is too short.
+std::vector<SDL_Color> getBinnedImage(std::ifstream* file, int binning);
+
+/// @brief Writes an image as binary greyscale PGM.
+/// @param filename Path of the file.
+/// @param colorVec Image stored in vector of SDL_Color objects.
+/// @param x_axis Width of the image.
+/// @return True if the file was written, otherwise false.
+bool writePGM(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis);
+
+/// @brief Writes an image as 8 bit RGB PNG.
+/// @param filename Path of the file.
+/// @param colorVec Image stored in vector of SDL_Color objects, alpha is dropped.
+/// @param x_axis Width of the image.
+/// @return True if the file was written, otherwise false.
+bool writePNG(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis);
+
 #endif
@@ -3,13 +3,80 @@
 #include "renderer.h"
 #include "ImageFilters.h"
 #include "starDetectionAlgorithm.h"
+#include "server.h"
+#include "quickLook.h"
+#include "offscreenRenderer.h"
+#include <cstring>
+#include <thread>
 
 
 SDL_Window* window = nullptr;
 SDL_Renderer* render = nullptr;
 
 
-int main(){
+int main(int argc, char* argv[]){
+
+    DetectionParameters parameters;
+    bool daemon = false;
+    bool useCache = false;
+    int binning = 0;//quick-look mode when not 0
+    std::string exportPath;//headless PNG export instead of the window when not empty
+    std::vector<std::string> filenames;
+    std::string socketPath = SOCKET_PATH;
+    size_t threads = std::thread::hardware_concurrency();
+
+    for(int i = 1; i < argc; ++i){
+        if(strcmp(argv[i], "--multiscale") == 0){
+            //runs detection on the a trous wavelet scales instead of a single blurred image
+            parameters.multiScale = true;
+        }else if(strcmp(argv[i], "--cache") == 0){
+            //reuses the catalogues of earlier runs on the same image and parameters
+            useCache = true;
+        }else if(strcmp(argv[i], "--daemon") == 0){
+            //--daemon [socket path] [threads] serves detection requests until SHUTDOWN
+            daemon = true;
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0){socketPath = argv[++i];}
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0){
+                char* end;
+                long count = strtol(argv[++i], &end, 10);
+                if(end == argv[i] || *end != '\0' || count < 1){
+                    std::cerr << "Usage: --daemon [socket path] [threads], threads must be a positive integer" << std::endl;
+                    return 1;
+                }
+                threads = count;
+            }
+        }else if(strcmp(argv[i], "--export") == 0 && i + 1 < argc){
+            //--export <file.png> writes the annotated image without opening a window
+            exportPath = argv[++i];
+        }else if(strcmp(argv[i], "--quicklook") == 0 && i + 1 < argc){
+            //--quicklook <2|4|8> [files] bins while reading and writes approximate catalogues and thumbnails
+            binning = atoi(argv[++i]);
+            if(binning != 2 && binning != 4 && binning != 8){
+                std::cerr << "Binning factor must be 2, 4 or 8" << std::endl;
+                return 1;
+            }
+        }else if(binning != 0 && strncmp(argv[i], "--", 2) != 0){
+            filenames.push_back(argv[i]);
+        }else{
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    ResultCache* cache = useCache ? new ResultCache() : nullptr;
+
+    if(binning != 0){
+        if(filenames.empty()){filenames.push_back(FILENAME);}
+        int exitCode = runQuickLook(filenames, binning, parameters, threads, cache);
+        delete cache;
+        return exitCode;
+    }
+
+    if(daemon){
+        int exitCode = runServer(socketPath, threads, parameters, cache);
+        delete cache;
+        return exitCode;
+    }
 
     std::ifstream* file = createFileStream();
 
@@ -19,23 +86,32 @@ int main(){
     std::vector<SDL_Color> colorVec = convertToColor(imageVec);
 
     std::vector<StarPixel> starPixelVec = VectorSDL_ColorToStarPixelFormat(colorVec);
-    std::vector<SDL_Color> blurredImage = GaussianBlur(colorVec, X_AXIS, 1.0, 5);
     std::vector<Star> stars;
-    addToStarClassVector(blurredImage, stars);
+    detectStars(colorVec, stars, parameters, X_AXIS, cache);
     findClosestStar(stars);
     linearHistogram(colorVec, 1.0);
     std::cout << "Number of stars detected: " << stars.size() << std::endl;
     
 
-    initializeSDL();
+    int exitCode = 0;
+    if(!exportPath.empty()){
+        if(!exportAnnotatedImage(exportPath, colorVec, X_AXIS, stars, threads)){
+            std::cerr << "Could not write " << exportPath << std::endl;
+            exitCode = 1;
+        }
+        closeLabelFont();
+    }else{
+        initializeSDL();
 
-    SDLTexture(colorVec, stars);
+        SDLTexture(colorVec, stars);
 
-    destroySDL();
+        destroySDL();
+    }
 
 
     delete[] header;
     delete file;
+    delete cache;
     
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,187 @@
+#include "offscreenRenderer.h"
+#include "threadPool.h"
+#include "fileio.h"
+#include <cmath>
+#include <mutex>
+
+static const SDL_Color red = {255, 0, 0, 255};
+static const SDL_Color labelGreen = {0, 255, 0, 255};
+
+//TTF shares one FreeType library and the font caches its glyphs, daemon workers exporting at the same time take turns
+static std::mutex ttfMutex;
+static TTF_Font* labelFont = nullptr;
+static bool labelFontOpened = false;//opening was attempted, it isn't retried on every export
+static bool ttfStarted = false;//TTF was started here and is stopped by closeLabelFont()
+
+
+/// @brief Sets a pixel if it lies inside the band, every band only writes its own rows.
+static inline void plot(std::vector<SDL_Color>& canvas, int width, int rowBegin, int rowEnd, int x, int y, SDL_Color color){
+    if(x >= 0 && x < width && y >= rowBegin && y < rowEnd){
+        canvas[y * width + x] = color;
+    }
+}
+
+
+/// @brief Same points as drawCircle(): 360 steps, each drawn 2 pixels wide.
+static void plotCircle(std::vector<SDL_Color>& canvas, int width, int rowBegin, int rowEnd, int cx, int cy, int radius){
+    if(cy + radius + 1 < rowBegin || cy - radius >= rowEnd){return;}
+    for(int i = 0; i < 360; ++i){
+        int x = cx + radius * cos(i * M_PI / 180);
+        int y = cy + radius * sin(i * M_PI / 180);
+        plot(canvas, width, rowBegin, rowEnd, x, y, red);
+        plot(canvas, width, rowBegin, rowEnd, x + 1, y, red);
+        plot(canvas, width, rowBegin, rowEnd, x, y + 1, red);
+    }
+}
+
+
+/// @brief Bresenham line including both end points, like SDL_RenderDrawLine().
+static void plotLine(std::vector<SDL_Color>& canvas, int width, int rowBegin, int rowEnd, int x0, int y0, int x1, int y1){
+    if(std::max(y0, y1) < rowBegin || std::min(y0, y1) >= rowEnd){return;}
+    int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    while(true){
+        plot(canvas, width, rowBegin, rowEnd, x0, y0, red);
+        if(x0 == x1 && y0 == y1){break;}
+        int error2 = 2 * error;
+        if(error2 >= dy){error += dy; x0 += sx;}
+        if(error2 <= dx){error += dx; y0 += sy;}
+    }
+}
+
+
+/// @brief Stretches the glyph mask over the label rectangle (nearest neighbour), as SDL_RenderCopy() does.
+static void plotLabel(std::vector<SDL_Color>& canvas, int width, int rowBegin, int rowEnd, const Label& label){
+    if(label.mask.empty()){return;}
+    int yBegin = std::max(label.rect.y, rowBegin);
+    int yEnd = std::min(label.rect.y + label.rect.h, rowEnd);
+    for(int y = yBegin; y < yEnd; ++y){
+        int maskY = (y - label.rect.y) * label.maskHeight / label.rect.h;
+        for(int x = label.rect.x; x < label.rect.x + label.rect.w; ++x){
+            int maskX = (x - label.rect.x) * label.maskWidth / label.rect.w;
+            if(label.mask[maskY * label.maskWidth + maskX]){
+                plot(canvas, width, rowBegin, rowEnd, x, y, labelGreen);
+            }
+        }
+    }
+}
+
+
+std::vector<Label> rasterizeLabels(std::vector<Star>& stars, TTF_Font* font){
+    std::vector<Label> labels(stars.size());
+    for(size_t i = 0; i < stars.size(); ++i){
+        std::string text = std::to_string(i);
+        Label& label = labels[i];
+        //same rectangle as printText()
+        label.rect.x = stars[i].avgX - 5;
+        label.rect.y = stars[i].avgY - 25;
+        label.rect.h = 25;
+        label.rect.w = text.size() * 10;
+        label.maskWidth = label.maskHeight = 0;
+        if(font == nullptr){continue;}
+
+        //solid text is rendered to an 8 bit surface where index 0 is the background
+        SDL_Surface* textSurface = TTF_RenderText_Solid(font, text.c_str(), labelGreen);
+        if(textSurface == nullptr){continue;}
+        label.maskWidth = textSurface->w;
+        label.maskHeight = textSurface->h;
+        label.mask.resize(label.maskWidth * label.maskHeight);
+        const uint8_t* pixels = static_cast<const uint8_t*>(textSurface->pixels);
+        for(int y = 0; y < label.maskHeight; ++y){
+            for(int x = 0; x < label.maskWidth; ++x){
+                label.mask[y * label.maskWidth + x] = pixels[y * textSurface->pitch + x] != 0;
+            }
+        }
+        SDL_FreeSurface(textSurface);
+    }
+    return labels;
+}
+
+
+void rasterizeBand(std::vector<SDL_Color>& canvas, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, const std::vector<Label>& labels, int rowBegin, int rowEnd){
+    const int width = x_axis;
+    std::copy(colorVec.begin() + rowBegin * x_axis, colorVec.begin() + rowEnd * x_axis, canvas.begin() + rowBegin * x_axis);
+
+    //stars are drawn in the same order as circleStars(), so overlaps look the same
+    for(size_t i = 0; i < stars.size(); ++i){
+        plotCircle(canvas, width, rowBegin, rowEnd, stars[i].avgX, stars[i].avgY, 10);
+        Star* closest = stars[i].getClosestStar();
+        if(closest != nullptr){
+            plotLine(canvas, width, rowBegin, rowEnd, stars[i].avgX, stars[i].avgY, closest->avgX, closest->avgY);
+        }
+        if(i < labels.size()){
+            plotLabel(canvas, width, rowBegin, rowEnd, labels[i]);
+        }
+    }
+}
+
+
+std::vector<SDL_Color> renderAnnotated(const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, const std::vector<Label>& labels, size_t threads){
+    std::vector<SDL_Color> canvas(colorVec.size());
+    const int y_axis = colorVec.size() / x_axis;
+
+    //a single band needs no pool, daemon workers export this way
+    if(threads <= 1){
+        rasterizeBand(canvas, colorVec, x_axis, stars, labels, 0, y_axis);
+        return canvas;
+    }
+
+    const int bandHeight = (y_axis + threads - 1) / threads;
+    ThreadPool pool(threads);
+    for(int rowBegin = 0; rowBegin < y_axis; rowBegin += bandHeight){
+        int rowEnd = std::min(rowBegin + bandHeight, y_axis);
+        pool.enqueue([&, rowBegin, rowEnd]{
+            rasterizeBand(canvas, colorVec, x_axis, stars, labels, rowBegin, rowEnd);
+        });
+    }
+    pool.wait();
+    return canvas;
+}
+
+
+/// @brief Opens the label font the first time it is called, ttfMutex has to be held.
+static TTF_Font* lockedLabelFont(){
+    if(labelFontOpened){return labelFont;}
+    labelFontOpened = true;
+
+    //TTF only renders into memory here, it doesn't need SDL video or a display
+    if(!TTF_WasInit()){
+        if(TTF_Init() == -1){
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to intitialize TTF, exporting without labels. Error: %s\n", SDL_GetError());
+            return nullptr;
+        }
+        ttfStarted = true;
+    }
+    labelFont = TTF_OpenFont(LABEL_FONT, 12);
+    if(labelFont == nullptr){
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s, exporting without labels. Error: %s\n", LABEL_FONT, SDL_GetError());
+    }
+    return labelFont;
+}
+
+
+bool openLabelFont(){
+    std::lock_guard<std::mutex> lock(ttfMutex);
+    return lockedLabelFont() != nullptr;
+}
+
+
+void closeLabelFont(){
+    std::lock_guard<std::mutex> lock(ttfMutex);
+    if(labelFont != nullptr){TTF_CloseFont(labelFont);}
+    if(ttfStarted){TTF_Quit();}
+    labelFont = nullptr;
+    labelFontOpened = ttfStarted = false;
+}
+
+
+bool exportAnnotatedImage(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, size_t threads){
+    std::vector<Label> labels;
+    {
+        std::lock_guard<std::mutex> lock(ttfMutex);
+        labels = rasterizeLabels(stars, lockedLabelFont());
+    }
+    std::vector<SDL_Color> canvas = renderAnnotated(colorVec, x_axis, stars, labels, threads);
+    return writePNG(filename, canvas, x_axis);
+}
@@ -0,0 +1,63 @@
+#ifndef OFFSCREENRENDERER_H
+#define OFFSCREENRENDERER_H
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "Stars.h"
+
+#define LABEL_FONT "fonts/Pixellettersfull-BnJ5.ttf"
+
+
+/// @brief Index of a star rendered to a glyph mask, placed where printText() would put it.
+struct Label{
+    SDL_Rect rect;//destination rectangle, the mask is stretched to fill it
+    int maskWidth, maskHeight;
+    std::vector<uint8_t> mask;//1 where the text is drawn
+};
+
+
+/// @brief Renders the star indices with TTF once, before the parallel rasterization (TTF isn't thread safe).
+/// @param stars Vector containing detected stars.
+/// @param font Font to be used, nullptr to render no labels.
+/// @return One label per star.
+std::vector<Label> rasterizeLabels(std::vector<Star>& stars, TTF_Font* font);
+
+/// @brief Rasterizes the image and the overlay of circleStars() into the rows [rowBegin, rowEnd) of the canvas.
+/// @param canvas Output image, same size as colorVec.
+/// @param colorVec Image stored in vector of SDL_Color objects (already stretched).
+/// @param x_axis Width of the image.
+/// @param stars Vector containing detected stars.
+/// @param labels Labels from rasterizeLabels().
+/// @param rowBegin First row of the band.
+/// @param rowEnd Row after the last row of the band.
+void rasterizeBand(std::vector<SDL_Color>& canvas, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, const std::vector<Label>& labels, int rowBegin, int rowEnd);
+
+/// @brief Renders the image with circles, neighbour lines and labels into memory without a window.
+/// @param colorVec Image stored in vector of SDL_Color objects (already stretched).
+/// @param x_axis Width of the image.
+/// @param stars Vector containing detected stars.
+/// @param labels Labels from rasterizeLabels().
+/// @param threads Number of horizontal bands rasterized in parallel, 1 rasterizes on the calling thread.
+/// @return Annotated image.
+std::vector<SDL_Color> renderAnnotated(const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, const std::vector<Label>& labels, size_t threads);
+
+/// @brief Starts TTF if nothing else did and opens LABEL_FONT once for every later export.
+/// @return True if the labels can be rendered, otherwise the images are exported without them.
+/// @note exportAnnotatedImage() calls it on first use, long running callers (the daemon) call it at startup.
+bool openLabelFont();
+
+/// @brief Closes the label font and stops TTF if openLabelFont() started it.
+void closeLabelFont();
+
+/// @brief Renders the annotated image and writes it as PNG, needs no display.
+/// @param filename Path of the PNG file.
+/// @param colorVec Image stored in vector of SDL_Color objects (already stretched).
+/// @param x_axis Width of the image.
+/// @param stars Vector containing detected stars.
+/// @param threads Number of horizontal bands rasterized in parallel.
+/// @return True if the file was written, otherwise false.
+bool exportAnnotatedImage(const std::string& filename, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars, size_t threads);
+
+#endif
@@ -0,0 +1,48 @@
+#include "quickLook.h"
+#include "threadPool.h"
+#include "fileio.h"
+#include <mutex>
+
+
+int quickLook(const std::string& filename, int binning, const DetectionParameters& parameters, ResultCache* cache){
+    std::ifstream* file = createFileStream(filename);
+    if(file == nullptr){return -1;}
+    std::vector<SDL_Color> colorVec = getBinnedImage(file, binning);
+    delete file;
+    if(colorVec.empty()){return -1;}
+
+    const size_t x_axis = X_AXIS / binning;
+    std::vector<Star> stars;
+    detectStars(colorVec, stars, scaleParameters(parameters, binning), x_axis, cache);
+    findClosestStar(stars);
+
+    std::ofstream catalogue(filename + ".quicklook.txt");
+    if(!catalogue.is_open()){return -1;}
+    writeCatalogue(catalogue, stars, binning);
+
+    if(!writePGM(filename + ".thumb.pgm", colorVec, x_axis)){return -1;}
+    return stars.size();
+}
+
+
+int runQuickLook(const std::vector<std::string>& filenames, int binning, const DetectionParameters& parameters, size_t threads, ResultCache* cache){
+    std::mutex outputMutex;
+    bool failed = false;
+    {
+        ThreadPool pool(threads);
+        for(const std::string& filename : filenames){
+            pool.enqueue([&, filename]{
+                int count = quickLook(filename, binning, parameters, cache);
+                std::lock_guard<std::mutex> lock(outputMutex);
+                if(count < 0){
+                    std::cerr << filename << ": could not be processed" << std::endl;
+                    failed = true;
+                }else{
+                    std::cout << filename << ": " << count << " stars (approximate)" << std::endl;
+                }
+            });
+        }
+        pool.wait();
+    }
+    return failed ? 1 : 0;
+}
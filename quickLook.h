@@ -0,0 +1,27 @@
+#ifndef QUICKLOOK_H
+#define QUICKLOOK_H
+
+#include <string>
+#include <vector>
+#include "starDetectionAlgorithm.h"
+
+
+/// @brief Bins the image while reading it, detects on the binned image and writes an approximate catalogue and a thumbnail.
+/// @param filename FITS file to process.
+/// @param binning Binning factor (2, 4 or 8).
+/// @param parameters Parameters for the full resolution image, they are scaled to the binned image.
+/// @param cache Result cache, nullptr to disable it. Binned images get their own keys since the key hashes the binned data.
+/// @return Number of stars detected, -1 if the file couldn't be read.
+/// @note Writes "<filename>.quicklook.txt" and "<filename>.thumb.pgm".
+int quickLook(const std::string& filename, int binning, const DetectionParameters& parameters, ResultCache* cache = nullptr);
+
+/// @brief Runs quickLook() on every file in parallel and prints the star counts.
+/// @param filenames FITS files to process.
+/// @param binning Binning factor (2, 4 or 8).
+/// @param parameters Parameters for the full resolution image.
+/// @param threads Number of worker threads.
+/// @param cache Result cache shared by the workers, nullptr to disable it.
+/// @return Exit code for main, 1 if any file failed.
+int runQuickLook(const std::vector<std::string>& filenames, int binning, const DetectionParameters& parameters, size_t threads, ResultCache* cache = nullptr);
+
+#endif
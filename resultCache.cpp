@@ -0,0 +1,178 @@
+#include "resultCache.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <tuple>
+#include <cstring>
+
+#define CACHE_MAGIC "FITSC001"
+
+namespace fs = std::filesystem;
+
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed){
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    uint64_t word;
+    size_t i = 0;
+    for(; i + sizeof(word) <= size; i += sizeof(word)){
+        memcpy(&word, bytes + i, sizeof(word));
+        hash ^= word;
+        hash *= 0x100000001b3ULL;
+        hash ^= hash >> 32;//the multiplication only carries upwards, this folds the high bits back down
+    }
+    for(; i < size; ++i){
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+//appends the raw bytes of a value to an entry
+template <typename T>
+static void appendValue(std::string& data, const T& value){
+    data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//reads a value from an entry, returns false if the entry is too short
+template <typename T>
+static bool readValue(const std::string& data, size_t& offset, T& value){
+    if(offset + sizeof(T) > data.size()){return false;}
+    memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t maxBytes){
+    this->directory = directory;
+    this->maxBytes = maxBytes;
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if(error){
+        std::cerr << "Could not create cache directory " << directory << ". Error: " << error.message() << std::endl;
+    }
+}
+
+std::string ResultCache::entryPath(uint64_t key, const std::string& stage){
+    std::ostringstream path;
+    path << directory << "/" << std::hex << key << "." << stage;
+    return path.str();
+}
+
+bool ResultCache::load(uint64_t key, const std::string& stage, std::string& data){
+    std::string path = entryPath(key, stage);
+    std::ifstream entry(path, std::ios::binary);
+    if(!entry.is_open()){return false;}
+
+    std::ostringstream contents;
+    contents << entry.rdbuf();
+    data = contents.str();
+    if(data.compare(0, strlen(CACHE_MAGIC), CACHE_MAGIC) != 0){return false;}
+    data.erase(0, strlen(CACHE_MAGIC));
+
+    //the modification time doubles as the last use for the LRU eviction
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return true;
+}
+
+void ResultCache::store(uint64_t key, const std::string& stage, const std::string& data){
+    std::string path = entryPath(key, stage);
+    std::ostringstream temporaryPath;
+    temporaryPath << path << ".tmp" << std::this_thread::get_id();
+    {
+        std::ofstream entry(temporaryPath.str(), std::ios::binary);
+        if(!entry.is_open()){return;}
+        entry << CACHE_MAGIC;
+        entry.write(data.data(), data.size());
+        if(!entry.good()){
+            entry.close();
+            std::error_code error;
+            fs::remove(temporaryPath.str(), error);
+            return;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporaryPath.str(), path, error);
+    if(error){
+        fs::remove(temporaryPath.str(), error);
+        return;
+    }
+    evict();
+}
+
+void ResultCache::evict(){
+    std::lock_guard<std::mutex> lock(evictionMutex);
+    std::vector<std::tuple<fs::file_time_type, fs::path, uint64_t>> entries;
+    uint64_t totalBytes = 0;
+    std::error_code error;
+
+    //incremented by hand, the range-for over a directory_iterator throws when an entry can't be read
+    fs::directory_iterator entry(directory, error), end;
+    for(; !error && entry != end; entry.increment(error)){
+        //temporary files of entries other threads are still writing are neither counted nor removed
+        if(entry->path().extension().string().compare(0, 4, ".tmp") == 0){continue;}
+
+        std::error_code entryError;
+        if(!entry->is_regular_file(entryError)){continue;}
+        uint64_t size = entry->file_size(entryError);
+        fs::file_time_type lastUse = entry->last_write_time(entryError);
+        if(entryError){continue;}//removed by another process in the meantime
+        totalBytes += size;
+        entries.emplace_back(lastUse, entry->path(), size);
+    }
+    if(totalBytes <= maxBytes){return;}
+
+    //oldest first
+    std::sort(entries.begin(), entries.end());
+    for(const std::tuple<fs::file_time_type, fs::path, uint64_t>& oldest : entries){
+        if(totalBytes <= maxBytes){break;}
+        std::error_code removeError;
+        if(fs::remove(std::get<1>(oldest), removeError)){
+            totalBytes -= std::get<2>(oldest);
+        }
+    }
+}
+
+
+bool ResultCache::loadCatalogue(uint64_t key, std::vector<Star>& stars){
+    std::string data;
+    size_t offset = 0;
+    uint32_t starCount, pixelCount;
+    int32_t x, y;
+    SDL_Color pixel;
+    if(!load(key, "catalogue", data) || !readValue(data, offset, starCount)){return false;}
+
+    std::vector<Star> loaded;
+    for(uint32_t i = 0; i < starCount; ++i){
+        if(!readValue(data, offset, pixelCount)){return false;}
+        Star star;
+        for(uint32_t j = 0; j < pixelCount; ++j){
+            if(!readValue(data, offset, x) || !readValue(data, offset, y) || !readValue(data, offset, pixel)){return false;}
+            star.addPixel(StarPixel(x, y, pixel));
+        }
+        loaded.push_back(star);
+    }
+    if(offset != data.size()){return false;}
+    stars.insert(stars.end(), loaded.begin(), loaded.end());
+    return true;
+}
+
+void ResultCache::storeCatalogue(uint64_t key, std::vector<Star>& stars){
+    std::string data;
+    appendValue(data, (uint32_t) stars.size());
+    for(Star& star : stars){
+        const std::vector<StarPixel>& starBlob = star.getStarBlob();
+        appendValue(data, (uint32_t) starBlob.size());
+        for(const StarPixel& pixel : starBlob){
+            appendValue(data, (int32_t) pixel.x);
+            appendValue(data, (int32_t) pixel.y);
+            appendValue(data, pixel.pixelValue);
+        }
+    }
+    store(key, "catalogue", data);
+}
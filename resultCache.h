@@ -0,0 +1,57 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include "Stars.h"
+
+#define CACHE_DIRECTORY ".fits_cache"
+#define CACHE_MAX_BYTES (1024ULL * 1024 * 1024) //least recently used entries are evicted above this size
+#define PIPELINE_VERSION 3 //part of every key, increase it whenever the code of a cached stage changes its output
+
+
+/// @brief 64 bit FNV-1a style hash taking 8 bytes per step, used to address cached products by content.
+/// @param data Bytes to hash.
+/// @param size Number of bytes.
+/// @param seed Hash of the data this is combined with, so keys can be chained stage by stage.
+/// @return Hash of the data.
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+
+/// @brief Combines a stage parameter into a key.
+template <typename T>
+uint64_t hashValue(uint64_t seed, const T& value){
+    return hashBytes(&value, sizeof(T), seed);
+}
+
+
+/// @brief On disk cache of star catalogues, keyed by the hash of the image intensities and the detection parameters.
+/// @note Blurred images and wavelet planes aren't cached, loading them costs as much as computing them again.
+/// @note Entries are written to a temporary file and renamed, so concurrent readers never see a partial entry.
+class ResultCache{
+    public:
+        /// @brief Creates the cache directory if it doesn't exist.
+        /// @param directory Directory the entries are stored in.
+        /// @param maxBytes Size limit of the directory.
+        ResultCache(const std::string& directory = CACHE_DIRECTORY, uint64_t maxBytes = CACHE_MAX_BYTES);
+
+        /// @brief Loads a cached catalogue, the closest stars aren't stored and have to be found again.
+        /// @return True on a hit, otherwise false.
+        bool loadCatalogue(uint64_t key, std::vector<Star>& stars);
+        void storeCatalogue(uint64_t key, std::vector<Star>& stars);
+
+    private:
+        std::string entryPath(uint64_t key, const std::string& stage);
+        bool load(uint64_t key, const std::string& stage, std::string& data);
+        void store(uint64_t key, const std::string& stage, const std::string& data);
+
+        /// @brief Removes the least recently used entries until the directory is below maxBytes.
+        void evict();
+
+        std::string directory;
+        uint64_t maxBytes;
+        std::mutex evictionMutex;
+};
+
+#endif
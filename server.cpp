@@ -0,0 +1,294 @@
+#include "server.h"
+#include "threadPool.h"
+#include "fileio.h"
+#include "offscreenRenderer.h"
+#include <sstream>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <cmath>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <poll.h>
+
+#define POLL_INTERVAL_MS 200 //how often blocked sockets check for a stop request
+
+//set by SIGINT, SIGTERM or a SHUTDOWN request
+static std::atomic<bool> stopRequested(false);
+
+static void requestStop(int){stopRequested = true;}
+
+
+bool parseRequest(const std::string& line, DetectionRequest& request, std::string& error){
+    std::istringstream stream(line);
+    std::string command, option;
+
+    stream >> command;
+    if(command != "DETECT"){
+        error = "unknown command " + command;
+        return false;
+    }
+    if(!(stream >> request.filename)){
+        error = "missing file name";
+        return false;
+    }
+
+    while(stream >> option){
+        size_t separator = option.find('=');
+        if(separator == std::string::npos){
+            error = "malformed option " + option;
+            return false;
+        }
+        std::string key = option.substr(0, separator);
+        std::string value = option.substr(separator + 1);
+        try{
+            if(key == "sigma"){
+                request.parameters.sigma = std::stod(value);
+                if(!std::isfinite(request.parameters.sigma) || request.parameters.sigma < MIN_SIGMA || request.parameters.sigma > MAX_SIGMA){throw std::invalid_argument(key);}
+            }else if(key == "kernel"){
+                request.parameters.kernelDimension = std::stoi(value);
+                if(request.parameters.kernelDimension < 1 || request.parameters.kernelDimension % 2 == 0){throw std::invalid_argument(key);}
+            }else if(key == "multiscale"){
+                request.parameters.multiScale = value == "1";
+            }else if(key == "scales"){
+                request.parameters.scales = std::stoi(value);
+                if(request.parameters.scales < 1 || request.parameters.scales > 10){throw std::invalid_argument(key);}
+            }else if(key == "out"){
+                request.output = value;
+            }else if(key == "png"){
+                request.image = value;
+            }else{
+                error = "unknown option " + key;
+                return false;
+            }
+        }catch(const std::exception&){
+            error = "invalid value for " + key;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::string handleRequest(const DetectionRequest& request, std::vector<uint16_t>& imageBuffer, ResultCache* cache){
+    std::ifstream* file = createFileStream(request.filename);
+    if(file == nullptr){
+        return "ERROR file not found " + request.filename + "\n";
+    }
+    getImage(file, imageBuffer);
+    delete file;
+
+    if(imageBuffer.size() < (size_t) X_AXIS * Y_AXIS){
+        return "ERROR image is smaller than " + std::to_string(X_AXIS) + "x" + std::to_string(Y_AXIS) + "\n";
+    }
+
+    std::vector<SDL_Color> colorVec = convertToColor(imageBuffer);
+    std::vector<Star> stars;
+    detectStars(colorVec, stars, request.parameters, X_AXIS, cache);
+    findClosestStar(stars);
+
+    //requests already run in parallel, so every image is rasterized by its own worker alone, without a pool
+    if(!request.image.empty() && !exportAnnotatedImage(request.image, colorVec, X_AXIS, stars, 1)){
+        return "ERROR can't write " + request.image + "\n";
+    }
+
+    std::ostringstream response;
+    if(!request.output.empty()){
+        std::ofstream catalogue(request.output);
+        if(!catalogue.is_open()){
+            return "ERROR can't write " + request.output + "\n";
+        }
+        writeCatalogue(catalogue, stars);
+        response << "OK " << stars.size() << " " << request.output << "\n";
+    }else{
+        response << "OK " << stars.size() << "\n";
+        writeCatalogue(response, stars);
+        response << "END\n";
+    }
+    return response.str();
+}
+
+
+/// @brief Sends the whole response, MSG_NOSIGNAL keeps a closed client from killing the server.
+static bool sendAll(int client, const std::string& response){
+    size_t sent = 0;
+    while(sent < response.size()){
+        ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if(n <= 0){return false;}
+        sent += n;
+    }
+    return true;
+}
+
+
+/// @brief A client connection, shared by the poll loop and the worker answering it.
+struct Connection{
+    int client;
+    std::string pending;//bytes read after the last complete line, only used by the poll loop
+    std::mutex mutex;
+    std::deque<std::string> requests;//lines waiting for the request in progress, so the responses keep their order
+    bool busy = false;//a worker is answering a request of this client
+
+    Connection(int client){this->client = client;}
+    ~Connection(){close(client);}//the last of the poll loop and the workers to let go closes the socket
+};
+
+
+/// @brief Answers one request line, then queues the next line of the same client if there is one.
+static void serveRequest(std::shared_ptr<Connection> connection, std::string line, ThreadPool& pool, const DetectionParameters& defaults, ResultCache* cache){
+    //every worker keeps its own image buffer between requests
+    thread_local std::vector<uint16_t> imageBuffer;
+    std::string response;
+    if(line == "SHUTDOWN"){
+        stopRequested = true;
+        response = "OK\n";
+    }else{
+        DetectionRequest request;
+        request.parameters = defaults;
+        std::string error;
+        if(parseRequest(line, request, error)){
+            response = handleRequest(request, imageBuffer, cache);
+        }else{
+            response = "ERROR " + error + "\n";
+        }
+    }
+    sendAll(connection->client, response);
+
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    if(connection->requests.empty()){
+        connection->busy = false;
+        return;
+    }
+    //queued instead of answered here, so a client sending many requests doesn't keep a worker from the others
+    std::string next = std::move(connection->requests.front());
+    connection->requests.pop_front();
+    pool.enqueue([connection, next, &pool, &defaults, cache]{serveRequest(connection, next, pool, defaults, cache);});
+}
+
+
+/// @brief Reads what the client sent and queues every complete line.
+/// @return False if the client disconnected or sent a line that is too long.
+static bool readRequests(std::shared_ptr<Connection>& connection, ThreadPool& pool, const DetectionParameters& defaults, ResultCache* cache){
+    char chunk[1024];
+    ssize_t n = read(connection->client, chunk, sizeof(chunk));
+    if(n <= 0){return false;}
+    connection->pending.append(chunk, n);
+
+    size_t newline;
+    while((newline = connection->pending.find('\n')) != std::string::npos){
+        std::string line = connection->pending.substr(0, newline);
+        connection->pending.erase(0, newline + 1);
+        if(!line.empty() && line.back() == '\r'){line.pop_back();}
+        if(line.empty()){continue;}
+
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        if(connection->busy){
+            connection->requests.push_back(line);
+        }else{
+            connection->busy = true;
+            pool.enqueue([connection, line, &pool, &defaults, cache]{serveRequest(connection, line, pool, defaults, cache);});
+        }
+    }
+
+    if(connection->pending.size() > MAX_REQUEST_LENGTH){
+        sendAll(connection->client, "ERROR request too long\n");
+        return false;
+    }
+    return true;
+}
+
+
+/// @brief Removes the socket file left behind by a server that didn't shut down cleanly.
+/// @return False if a server still answers on the path or the path is not a socket, the file is then left alone.
+static bool removeStaleSocket(const sockaddr_un& address){
+    struct stat status;
+    if(lstat(address.sun_path, &status) < 0){return errno == ENOENT;}
+    if(!S_ISSOCK(status.st_mode)){return false;}
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(probe < 0){return false;}
+    bool answered = connect(probe, (const sockaddr*) &address, sizeof(address)) == 0;
+    int error = errno;
+    close(probe);
+    //only a refused connection means nobody is listening, any other failure leaves the socket in place
+    if(answered || error != ECONNREFUSED){return false;}
+    return unlink(address.sun_path) == 0 || errno == ENOENT;
+}
+
+
+int runServer(const std::string& socketPath, size_t threads, const DetectionParameters& defaults, ResultCache* cache){
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(socketPath.size() >= sizeof(address.sun_path)){
+        std::cerr << "Socket path too long: " << socketPath << std::endl;
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0){
+        std::cerr << "Could not create socket. Error: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    if(!removeStaleSocket(address)){
+        std::cerr << "Not starting, " << socketPath << " is in use by a running server or is not a socket." << std::endl;
+        close(listener);
+        return 1;
+    }
+    if(bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0){
+        std::cerr << "Could not listen on " << socketPath << ". Error: " << strerror(errno) << std::endl;
+        close(listener);
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    {
+        //workers are started once and reused for every request, the sockets are only read by this thread
+        ThreadPool pool(threads);
+        std::cout << "Listening on " << socketPath << " with " << pool.size() << " workers." << std::endl;
+        //the font is opened once here instead of by every request that asks for an image
+        openLabelFont();
+
+        std::vector<std::shared_ptr<Connection>> connections;
+        std::vector<pollfd> polled;
+        while(!stopRequested){
+            polled.assign(1, pollfd{listener, POLLIN, 0});
+            for(const std::shared_ptr<Connection>& connection : connections){
+                polled.push_back(pollfd{connection->client, POLLIN, 0});
+            }
+            if(poll(polled.data(), polled.size(), POLL_INTERVAL_MS) <= 0){continue;}
+
+            //connections are dropped here once the client is gone, workers still answering keep theirs open
+            size_t kept = 0;
+            for(size_t k = 0; k < connections.size(); ++k){
+                bool open = true;
+                if(polled[k + 1].revents & (POLLIN | POLLHUP | POLLERR)){
+                    open = readRequests(connections[k], pool, defaults, cache);
+                }
+                if(open){connections[kept++] = connections[k];}
+            }
+            connections.resize(kept);
+
+            if(polled[0].revents & POLLIN){
+                int client = accept(listener, nullptr, nullptr);
+                if(client >= 0){connections.push_back(std::make_shared<Connection>(client));}
+            }
+        }
+        //requests read before the stop are still answered before the pool is destroyed, later ones aren't read
+    }
+
+    closeLabelFont();
+    close(listener);
+    unlink(socketPath.c_str());
+    std::cout << "Server stopped." << std::endl;
+    return 0;
+}
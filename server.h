@@ -0,0 +1,45 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <vector>
+#include "starDetectionAlgorithm.h"
+
+#define SOCKET_PATH "/tmp/fits_detection.sock"
+#define MAX_REQUEST_LENGTH 4096
+#define MIN_SIGMA 0.1 //smaller standard deviations make the Gaussian kernel degenerate
+#define MAX_SIGMA 100.0
+
+
+/// @brief A detection request received over the socket.
+struct DetectionRequest{
+    std::string filename;//FITS file to process
+    std::string output;//catalogue is written here, empty to send it back over the socket
+    std::string image;//annotated PNG is written here, empty for none
+    DetectionParameters parameters;
+};
+
+
+/// @brief Parses a request line of the form "DETECT <file> [sigma=] [kernel=] [multiscale=] [scales=] [out=] [png=]".
+/// @param line Request line without the newline.
+/// @param request Parsed request, parameters that aren't given keep the server defaults.
+/// @param error Reason the line was rejected.
+/// @return True if the line is a valid request, otherwise false.
+bool parseRequest(const std::string& line, DetectionRequest& request, std::string& error);
+
+/// @brief Loads the image, detects the stars and writes the catalogue.
+/// @param request Request to process.
+/// @param imageBuffer Buffer of the worker, reused between requests.
+/// @param cache Result cache shared by the workers, nullptr to disable it.
+/// @return Response sent back to the client.
+std::string handleRequest(const DetectionRequest& request, std::vector<uint16_t>& imageBuffer, ResultCache* cache);
+
+/// @brief Runs the detection server until a SHUTDOWN request, SIGINT or SIGTERM is received.
+/// @param socketPath Path of the Unix domain socket.
+/// @param threads Number of worker threads, each answers one request at a time.
+/// @param defaults Parameters used when a request doesn't override them.
+/// @param cache Result cache shared by the workers, nullptr to disable it.
+/// @return Exit code for main.
+int runServer(const std::string& socketPath, size_t threads, const DetectionParameters& defaults, ResultCache* cache);
+
+#endif
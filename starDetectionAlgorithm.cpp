@@ -1,17 +1,21 @@
 #include "starDetectionAlgorithm.h"
+#include <algorithm>
+#include <unordered_map>
 
 
-bool checkPixelSurroundings(int x_, int y_, std::vector<SDL_Color>& colorVec){
+bool checkPixelSurroundings(int x_, int y_, std::vector<SDL_Color>& colorVec, size_t x_axis){
     //compares the 8 pixels surrounding the pixel examined for being above threshold
     int valueSum = 0; //hold the sum of the surrounding pixel values
     uint8_t avgValue;
-    if (y_ < 5 || y_ > (Y_AXIS - 5) || x_ < 5 || x_ > (X_AXIS - 5)){
+    const int width = x_axis;
+    const int height = colorVec.size() / x_axis;
+    if (y_ < 5 || y_ > (height - 5) || x_ < 5 || x_ > (width - 5)){
         return false;
     }
     for (uint16_t y = y_ - 1; y < y_ + 2; ++y){
         for (uint16_t x = x_ - 1; x < x_ + 2; ++x){
             if(x != x_ && y != y_){
-                valueSum += colorVec[y * X_AXIS + x].b;
+                valueSum += colorVec[y * x_axis + x].b;
             }
         }
     }
@@ -21,7 +25,7 @@ bool checkPixelSurroundings(int x_, int y_, std::vector<SDL_Color>& colorVec){
 }
 
 
-int32_t returnStarIndex(int x, int y, std::vector<Star> &stars){
+int32_t returnStarIndex(int x, int y, std::vector<Star> &stars, int distinctionDistance){
     //if the stars vector is empty, return -1
     if(stars.size() == 0){return -1;}
     uint32_t minDistance; //minimum distance between a pixel compared to a pixel belonging to a star
@@ -39,7 +43,7 @@ int32_t returnStarIndex(int x, int y, std::vector<Star> &stars){
             if(minDistance > distance){
                 minDistance = distance;
             }
-            if (minDistance < MINIMUM_DISTINCTION_DISTANCE){
+            if (minDistance < (uint32_t) distinctionDistance){
                 return i;
             }
         }
@@ -48,22 +52,23 @@ int32_t returnStarIndex(int x, int y, std::vector<Star> &stars){
 } 
 
 
-void addToStarClassVector(std::vector<SDL_Color> &colorVec, std::vector<Star>& stars){
+void addToStarClassVector(std::vector<SDL_Color> &colorVec, std::vector<Star>& stars, size_t x_axis, int distinctionDistance){
     int32_t index;//holds return value of returnStarIndex
     int x,y;
+    const size_t y_axis = colorVec.size() / x_axis;
     for (size_t i = 0; i < colorVec.size(); ++i){
-        if ((i / X_AXIS) < 5 || (i / X_AXIS) > (Y_AXIS - 5) || (i % X_AXIS) < 5 || (i % X_AXIS) > (X_AXIS - 5)){
+        if ((i / x_axis) < 5 || (i / x_axis) > (y_axis - 5) || (i % x_axis) < 5 || (i % x_axis) > (x_axis - 5)){
             
         }else{
             //if pixel intensity is above threshold
             if(colorVec[i].b > THRESHOLD){
 
                 //and if the 8 surrounding pixels are also above threshold
-                x = i % X_AXIS;
-                y = i / X_AXIS;
+                x = i % x_axis;
+                y = i / x_axis;
                 
-                if(checkPixelSurroundings(x, y, colorVec)){
-                    index = returnStarIndex(x, y, stars);
+                if(checkPixelSurroundings(x, y, colorVec, x_axis)){
+                    index = returnStarIndex(x, y, stars, distinctionDistance);
                     if(index == -1){
                         //creates new star object and adds pixel to it
                         stars.push_back(Star(StarPixel(x, y, colorVec[i])));
@@ -76,4 +81,291 @@ void addToStarClassVector(std::vector<SDL_Color> &colorVec, std::vector<Star>& s
             }
         }
     }
-}
\ No newline at end of file
+}
+
+float estimateWaveletNoise(const std::vector<float>& coefficients){
+    //iterative 3 sigma clipping, the MAD collapses to zero on integer valued images
+    double sigma = 1e30;
+    for(int iteration = 0; iteration < 5; ++iteration){
+        double sum = 0.0, sumSq = 0.0;
+        size_t count = 0;
+        for(float w : coefficients){
+            if(std::fabs(w) < 3.0 * sigma){
+                sum += w;
+                sumSq += w * w;
+                ++count;
+            }
+        }
+        if(count == 0){break;}
+        double mean = sum / count;
+        sigma = std::sqrt(std::max(0.0, sumSq / count - mean * mean));
+    }
+    return sigma;
+}
+
+
+std::vector<float> waveletNoiseLevels(const WaveletPlanes& planes){
+    std::vector<float> noise(planes.coefficients.size());
+    if(noise.empty()){return noise;}
+
+    //the finest scale is almost pure noise, the coarse ones are dominated by the stars and the background
+    const float imageNoise = estimateWaveletNoise(planes.coefficients[0]) / B3SplineKernel::noiseFactor(0);
+    for(size_t j = 0; j < noise.size(); ++j){
+        noise[j] = imageNoise * B3SplineKernel::noiseFactor(j);
+    }
+    return noise;
+}
+
+
+std::vector<uint16_t> multiresolutionSupport(const WaveletPlanes& planes, const std::vector<float>& noise){
+    std::vector<uint16_t> support(planes.residual.size(), 0);
+    for(size_t j = 0; j < planes.coefficients.size(); ++j){
+        const std::vector<float>& coefficients = planes.coefficients[j];
+        const float threshold = WAVELET_SIGNIFICANCE * noise[j];
+        //only positive coefficients, stars are brighter than the background
+        for(size_t i = 0; i < support.size(); ++i){
+            if(coefficients[i] > threshold){
+                support[i] |= 1 << j;
+            }
+        }
+    }
+    return support;
+}
+
+
+/// @brief Rejects objects that aren't point-like from the second moments of their pixels.
+/// @param pixels Pixel indices of the object.
+/// @param objectOf Object every pixel belongs to.
+/// @param object Index of the object.
+/// @param colorVec Vector of SDL_Color object, contains image.
+/// @param x_axis Width of the image.
+/// @return True if the object is compact and filled, otherwise false.
+static bool isPointLike(const std::vector<size_t>& pixels, const std::vector<int32_t>& objectOf, int32_t object, const std::vector<SDL_Color>& colorVec, size_t x_axis){
+    double meanX = 0.0, meanY = 0.0, meanIntensity = 0.0;
+    for(size_t i : pixels){
+        meanX += i % x_axis;
+        meanY += i / x_axis;
+        meanIntensity += colorVec[i].b;
+    }
+    meanX /= pixels.size();
+    meanY /= pixels.size();
+    meanIntensity /= pixels.size();
+
+    //a ring or an arc has its centroid outside the object, unless it is the edge of a saturated star whose flat core is brighter
+    size_t centre = (size_t) (meanY + 0.5) * x_axis + (size_t) (meanX + 0.5);
+    if(objectOf[centre] != object && colorVec[centre].b <= meanIntensity){return false;}
+
+    double xx = 0.0, yy = 0.0, xy = 0.0;
+    for(size_t i : pixels){
+        double dx = (double) (i % x_axis) - meanX;
+        double dy = (double) (i / x_axis) - meanY;
+        xx += dx * dx;
+        yy += dy * dy;
+        xy += dx * dy;
+    }
+    //eigenvalues of the covariance are the squared major and minor axes, diffraction spikes come in symmetric pairs
+    double mean = (xx + yy) / 2.0;
+    double spread = std::sqrt((xx - yy) * (xx - yy) / 4.0 + xy * xy);
+    double major = mean + spread, minor = mean - spread;
+    if(minor <= 0.0){return false;}
+    return std::sqrt(major / minor) <= WAVELET_MAX_ELONGATION;
+}
+
+
+/// @brief Connected region of the multiresolution support on one scale.
+struct SupportRegion{
+    int scale;
+    std::vector<size_t> pixels;
+    int32_t parent = -1;//region it overlaps most on the next coarser scale
+    bool reachesFinest = false;//linked through every finer scale down to a region on the finest scale
+    int sourceChildren = 0;//regions on the next finer scale that are sources and have it as parent
+    int32_t object = -1;
+};
+
+
+void findSupportObjects(const std::vector<uint16_t>& support, int scales, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars){
+    const int width = x_axis;
+    const int height = support.size() / x_axis;
+    const int sourceScale = std::min(WAVELET_MIN_SCALES, scales) - 1;//objects are built from the regions of this scale
+    std::vector<SupportRegion> regions;
+    std::vector<std::vector<int32_t>> labels(scales, std::vector<int32_t>(support.size(), -1));
+    std::vector<size_t> stack;
+
+    //flood fills the 8-connected significant coefficients of every scale into regions, finest scale first
+    for(int j = 0; j < scales; ++j){
+        std::vector<int32_t>& label = labels[j];
+        for(int y = 5; y < height - 5; ++y){
+            for(int x = 5; x < width - 5; ++x){
+                size_t i = y * x_axis + x;
+                if(!(support[i] & (1 << j)) || label[i] != -1){continue;}
+
+                SupportRegion region;
+                region.scale = j;
+                label[i] = regions.size();
+                stack.push_back(i);
+                while(!stack.empty()){
+                    size_t k = stack.back();
+                    stack.pop_back();
+                    region.pixels.push_back(k);
+                    int px = k % x_axis, py = k / x_axis;
+                    for(int ny = py - 1; ny <= py + 1; ++ny){
+                        for(int nx = px - 1; nx <= px + 1; ++nx){
+                            if(nx < 5 || nx >= width - 5 || ny < 5 || ny >= height - 5){continue;}
+                            size_t n = ny * x_axis + nx;
+                            if((support[n] & (1 << j)) && label[n] == -1){
+                                label[n] = regions.size();
+                                stack.push_back(n);
+                            }
+                        }
+                    }
+                }
+                region.reachesFinest = j == 0 && region.pixels.size() >= WAVELET_MIN_PIXELS;
+                regions.push_back(std::move(region));
+            }
+        }
+    }
+
+    //links every region to the coarser region it overlaps most, children come before their parents in the vector
+    std::unordered_map<int32_t, size_t> overlap;
+    for(SupportRegion& region : regions){
+        if(region.scale + 1 >= scales){continue;}
+        overlap.clear();
+        for(size_t i : region.pixels){
+            int32_t coarser = labels[region.scale + 1][i];
+            if(coarser != -1){++overlap[coarser];}
+        }
+        size_t largest = 0;
+        for(const std::pair<const int32_t, size_t>& candidate : overlap){
+            if(candidate.second > largest){
+                largest = candidate.second;
+                region.parent = candidate.first;
+            }
+        }
+        if(region.parent == -1 || !region.reachesFinest){continue;}
+        regions[region.parent].reachesFinest = true;
+        if(region.scale >= sourceScale){++regions[region.parent].sourceChildren;}
+    }
+
+    //every source starts an object, noise peaks on the finer scales (e.g. in a saturated core) belong to the source above them
+    std::vector<int32_t> sources;
+    for(size_t r = 0; r < regions.size(); ++r){
+        if(regions[r].scale == sourceScale && regions[r].reachesFinest){
+            regions[r].object = sources.size();
+            sources.push_back(r);
+        }
+    }
+    for(size_t r = regions.size(); r-- > 0;){
+        if(regions[r].scale < sourceScale && regions[r].parent != -1){
+            regions[r].object = regions[regions[r].parent].object;
+        }
+    }
+
+    std::vector<std::vector<size_t>> objectPixels(sources.size());
+    std::vector<int32_t> objectOf(support.size(), -1);
+    for(const SupportRegion& region : regions){
+        if(region.object == -1 || region.scale > sourceScale){continue;}
+        for(size_t i : region.pixels){
+            if(objectOf[i] == -1){
+                objectOf[i] = region.object;
+                objectPixels[region.object].push_back(i);
+            }
+        }
+    }
+
+    for(int32_t object = 0; object < (int32_t) sources.size(); ++object){
+        std::vector<size_t>& pixels = objectPixels[object];
+        if(pixels.size() < WAVELET_MIN_PIXELS || !isPointLike(pixels, objectOf, object, colorVec, x_axis)){continue;}
+
+        //the halo on the coarser scales is added while no other source shares it and the object stays point-like
+        int32_t parent = regions[sources[object]].parent;
+        while(parent != -1 && regions[parent].sourceChildren == 1){
+            size_t added = pixels.size();
+            for(size_t i : regions[parent].pixels){
+                if(objectOf[i] == -1){
+                    objectOf[i] = object;
+                    pixels.push_back(i);
+                }
+            }
+            if(!isPointLike(pixels, objectOf, object, colorVec, x_axis)){
+                for(size_t k = added; k < pixels.size(); ++k){
+                    objectOf[pixels[k]] = -1;
+                }
+                pixels.resize(added);
+                break;
+            }
+            parent = regions[parent].parent;
+        }
+
+        Star star;
+        for(size_t i : pixels){
+            star.addPixel(StarPixel(i % x_axis, i / x_axis, colorVec[i]));
+        }
+        stars.push_back(star);
+    }
+}
+
+
+void addToStarClassVectorMultiScale(const std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, size_t x_axis, int scales){
+    addToStarClassVectorMultiScale(atrousTransform(colorVec, x_axis, scales), colorVec, stars, x_axis);
+}
+
+
+void addToStarClassVectorMultiScale(const WaveletPlanes& planes, const std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, size_t x_axis){
+    std::vector<uint16_t> support = multiresolutionSupport(planes, waveletNoiseLevels(planes));
+    findSupportObjects(support, planes.coefficients.size(), colorVec, x_axis, stars);
+}
+
+
+/// @brief Key of the catalogue produced from an image by the detection parameters.
+static uint64_t catalogueKey(const std::vector<SDL_Color>& colorVec, const DetectionParameters& parameters, size_t x_axis){
+    //only the blue channel is hashed, convertToColor() and the binning set r, g and b to the same value and alpha to 255
+    std::vector<uint8_t> intensity(colorVec.size());
+    for(size_t i = 0; i < colorVec.size(); ++i){
+        intensity[i] = colorVec[i].b;
+    }
+    uint64_t key = hashBytes(intensity.data(), intensity.size());
+    key = hashValue(key, (uint32_t) PIPELINE_VERSION);
+    key = hashValue(key, (uint64_t) x_axis);
+    key = hashValue(key, parameters.multiScale);
+    if(parameters.multiScale){
+        key = hashValue(key, parameters.scales);
+        key = hashValue(hashValue(key, WAVELET_SIGNIFICANCE), WAVELET_MIN_PIXELS);
+        key = hashValue(hashValue(key, WAVELET_MIN_SCALES), WAVELET_MAX_ELONGATION);
+    }else{
+        key = hashValue(hashValue(key, parameters.sigma), parameters.kernelDimension);
+        key = hashValue(hashValue(key, THRESHOLD), parameters.distinctionDistance);
+    }
+    return key;
+}
+
+
+void detectStars(std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, const DetectionParameters& parameters, size_t x_axis, ResultCache* cache){
+    //only the catalogue is cached, blurring or transforming again is cheaper than loading the planes
+    uint64_t key = 0;
+    if(cache != nullptr){
+        key = catalogueKey(colorVec, parameters, x_axis);
+        if(cache->loadCatalogue(key, stars)){return;}
+    }
+
+    if(parameters.multiScale){
+        addToStarClassVectorMultiScale(colorVec, stars, x_axis, parameters.scales);
+    }else{
+        std::vector<SDL_Color> blurredImage = GaussianBlur(colorVec, x_axis, parameters.sigma, parameters.kernelDimension);
+        addToStarClassVector(blurredImage, stars, x_axis, parameters.distinctionDistance);
+    }
+
+    if(cache != nullptr){cache->storeCatalogue(key, stars);}
+}
+
+
+DetectionParameters scaleParameters(const DetectionParameters& parameters, int binning){
+    DetectionParameters scaled = parameters;
+    int octaves = 0;//log2 of the binning factor
+    while((1 << (octaves + 1)) <= binning){++octaves;}
+
+    scaled.sigma = std::max(parameters.sigma / binning, 0.5);
+    scaled.kernelDimension = std::max(3, (parameters.kernelDimension / binning) | 1);
+    scaled.distinctionDistance = std::max(2, parameters.distinctionDistance / binning);
+    scaled.scales = std::max(1, parameters.scales - octaves);
+    return scaled;
+}
@@ -3,28 +3,103 @@
 
 #include "Stars.h"
 #include "renderer.h"
+#include "ImageFilters.h"
+#include "resultCache.h"
 
 #define THRESHOLD 70
 #define MINIMUM_DISTINCTION_DISTANCE 15
 
+#define WAVELET_SCALES 4
+#define WAVELET_SIGNIFICANCE 5.0 //coefficients above this many standard deviations of the noise are significant
+#define WAVELET_MIN_PIXELS 3 //smaller objects are discarded as noise
+#define WAVELET_MIN_SCALES 3 //objects significant on fewer scales are discarded as noise
+#define WAVELET_MAX_ELONGATION 2.5 //ratio of the major to the minor axis above which an object is a trail or a spike
+
+
+/// @brief Parameters of one detection run.
+struct DetectionParameters{
+    double sigma = 1.0;//standard deviation of the Gaussian blur
+    int kernelDimension = 5;//size of the Gaussian kernel
+    bool multiScale = false;//detect on the wavelet scales instead of the blurred image
+    int scales = WAVELET_SCALES;
+    int distinctionDistance = MINIMUM_DISTINCTION_DISTANCE;//pixels closer than this to a star belong to it
+};
+
 
 /// @brief Checks the surrounding pixels of the pixel coordinates entered to see if they are above THRESHOLD.
 /// @param x_ X coordinate of pixel to be checked.
 /// @param y_ Y coordinate of pixel to be checked.
 /// @param colorVec Vector of SDL_Color object containing image data.
+/// @param x_axis Width of the image.
 /// @return True if surrounding pixels are above threshold, otherwise false.
-bool checkPixelSurroundings(int x_, int y_, std::vector<SDL_Color>& colorVec);
+bool checkPixelSurroundings(int x_, int y_, std::vector<SDL_Color>& colorVec, size_t x_axis = X_AXIS);
 
 /// @brief Determines if the pixel belongs to a star object that is already constructed.
 /// @param x X coordinate of pixel to be checked.
 /// @param y Y coordinate of pixel to be checked.
 /// @param stars Vector containing all Star objects.
+/// @param distinctionDistance Pixels closer than this to a star belong to it.
 /// @return If star is found, returns index of star in vector of Star objects, otherwise returns -1.
-int32_t returnStarIndex(int x, int y, std::vector<Star> &stars);
+int32_t returnStarIndex(int x, int y, std::vector<Star> &stars, int distinctionDistance = MINIMUM_DISTINCTION_DISTANCE);
 
 /// @brief Checks if a pixel could be part of a star, if it is then it appends it to one of the existing Star objects or creates a new one.
 /// @param colorVec Vector of SDL_Color object, contains image.
 /// @param stars Vector of Star objects.
-void addToStarClassVector(std::vector<SDL_Color> &colorVec, std::vector<Star>& stars);
+/// @param x_axis Width of the image.
+/// @param distinctionDistance Pixels closer than this to a star belong to it.
+void addToStarClassVector(std::vector<SDL_Color> &colorVec, std::vector<Star>& stars, size_t x_axis = X_AXIS, int distinctionDistance = MINIMUM_DISTINCTION_DISTANCE);
+
+/// @brief Estimates the noise standard deviation of a wavelet scale with sigma clipping.
+/// @param coefficients Wavelet coefficients of one scale.
+/// @return Standard deviation of the noise.
+float estimateWaveletNoise(const std::vector<float>& coefficients);
+
+/// @brief Estimates the noise on the finest scale, where stars hardly contribute, and propagates it to the coarser ones.
+/// @param planes Wavelet transform of the image.
+/// @return Standard deviation of the noise of every scale.
+std::vector<float> waveletNoiseLevels(const WaveletPlanes& planes);
+
+/// @brief Builds the multiresolution support, bit j of a pixel is set if its coefficient on scale j is significant.
+/// @param planes Wavelet transform of the image.
+/// @param noise Noise of every scale from waveletNoiseLevels().
+/// @return Support mask of every pixel.
+std::vector<uint16_t> multiresolutionSupport(const WaveletPlanes& planes, const std::vector<float>& noise);
+
+/// @brief Links the connected significant regions of every scale to the overlapping region of the next coarser scale, so one star is one object across the scales.
+/// @param support Multiresolution support from multiresolutionSupport().
+/// @param scales Number of wavelet scales.
+/// @param colorVec Vector of SDL_Color object, contains image.
+/// @param x_axis Width of the image.
+/// @param stars Vector the point-like objects are appended to, elongated and ring shaped ones are rejected.
+/// @note Objects are built from the regions of scale WAVELET_MIN_SCALES - 1, a coarser region shared by several of them (a bright halo) isn't added to any.
+void findSupportObjects(const std::vector<uint16_t>& support, int scales, const std::vector<SDL_Color>& colorVec, size_t x_axis, std::vector<Star>& stars);
+
+/// @brief Multi-scale detection on the a trous wavelet transform of the image.
+/// @param colorVec Vector of SDL_Color object, contains image (not blurred).
+/// @param stars Vector of Star objects.
+/// @param x_axis Width of the image.
+/// @param scales Number of wavelet scales.
+void addToStarClassVectorMultiScale(const std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, size_t x_axis, int scales);
+
+/// @brief Multi-scale detection on wavelet planes that were already computed.
+/// @param planes Wavelet transform of the image.
+/// @param colorVec Vector of SDL_Color object, contains image (not blurred).
+/// @param stars Vector of Star objects.
+/// @param x_axis Width of the image.
+void addToStarClassVectorMultiScale(const WaveletPlanes& planes, const std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, size_t x_axis);
+
+/// @brief Runs the detection pipeline selected by the parameters.
+/// @param colorVec Vector of SDL_Color object, contains image.
+/// @param stars Vector the detected Star objects are added to.
+/// @param parameters Parameters of the detection.
+/// @param x_axis Width of the image.
+/// @param cache If not nullptr, the catalogue is loaded from it when it was computed before, otherwise it is stored there.
+void detectStars(std::vector<SDL_Color>& colorVec, std::vector<Star>& stars, const DetectionParameters& parameters, size_t x_axis, ResultCache* cache = nullptr);
+
+/// @brief Scales the detection parameters to an image binned by the given factor.
+/// @param parameters Parameters for the full resolution image.
+/// @param binning Binning factor.
+/// @return Parameters for the binned image.
+DetectionParameters scaleParameters(const DetectionParameters& parameters, int binning);
 
 #endif
\ No newline at end of file
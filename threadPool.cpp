@@ -0,0 +1,63 @@
+#include "threadPool.h"
+
+
+ThreadPool::ThreadPool(size_t threads){
+    busyWorkers = 0;
+    stopping = false;
+    if(threads == 0){threads = 1;}
+    for(size_t i = 0; i < threads; ++i){
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        tasks.push(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::wait(){
+    std::unique_lock<std::mutex> lock(queueMutex);
+    allDone.wait(lock, [this]{return tasks.empty() && busyWorkers == 0;});
+}
+
+size_t ThreadPool::size(){return workers.size();}
+
+void ThreadPool::workerLoop(){
+    while(true){
+        //declared per task so whatever it captured is released as soon as it has run
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            taskAvailable.wait(lock, [this]{return stopping || !tasks.empty();});
+            //queued tasks are still executed when stopping
+            if(tasks.empty()){return;}
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++busyWorkers;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            --busyWorkers;
+            if(tasks.empty() && busyWorkers == 0){
+                allDone.notify_all();
+            }
+        }
+    }
+}
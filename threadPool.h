@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+/// @brief Fixed set of worker threads that stay alive and execute queued tasks.
+class ThreadPool{
+    public:
+        /// @brief Starts the worker threads.
+        /// @param threads Number of workers, at least one is started.
+        ThreadPool(size_t threads);
+
+        /// @brief Finishes the queued tasks and joins the workers.
+        ~ThreadPool();
+
+        /// @brief Queues a task to be executed by the first free worker.
+        /// @param task Task to execute.
+        void enqueue(std::function<void()> task);
+
+        /// @brief Blocks until the queue is empty and no worker is busy.
+        void wait();
+
+        /// @brief Getter for the number of workers.
+        /// @return Number of worker threads.
+        size_t size();
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex queueMutex;
+        std::condition_variable taskAvailable;
+        std::condition_variable allDone;
+        size_t busyWorkers;//workers currently executing a task
+        bool stopping;
+};
+
+#endif